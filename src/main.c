@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include <xinput.h>
 #include <dsound.h>
+#include <stdio.h>
+#include <string.h>
 
 // TODO: implement sine
 #include <math.h>
@@ -260,6 +262,881 @@ Win32UpdateWindow(win32_backbuffer *Buffer, HDC DeviceContext, int WindowWidth,
         SRCCOPY);
 }
 
+/*
+    Frame capture
+
+    Stream layout (all fields little endian uint32):
+        capture_file_header
+        per frame:   capture_frame_header
+        per changed: capture_tile_header, EncodedSize bytes
+
+    Each frame is diffed against the previously captured frame in
+    CAPTURE_TILE_SIZE x CAPTURE_TILE_SIZE tiles. Each changed tile is stored
+    with whichever capture_tile_encoding comes out smallest:
+        CaptureTile_XorRuns:  XOR of new and old pixels, run-length encoded
+        CaptureTile_LeftRuns: each new pixel minus its left neighbour (first
+                              pixel of a row as is), run-length encoded
+        CaptureTile_Raw:      the new pixels, when neither run form is smaller
+    XOR deltas only form runs when content moves vertically; a horizontal
+    scroll of a gradient gives 1,3,1,7,1,3,1,15... per row, while the left
+    difference of a gradient row is constant whichever way it moved.
+    Runs are coded in 32-bit words:
+        Header & 0x80: ((Header & 0x7F) + 1) copies of the next word
+        otherwise:     ((Header & 0x7F) + 1) literal words follow
+    Both the encoder and the decoder start from an all-zero frame.
+*/
+#define CAPTURE_MAGIC 0x32504352 // 'RCP2'
+#define CAPTURE_TILE_SIZE 16
+#define CAPTURE_MAX_TILE_SIZE 256
+// Keeps Width * Height * 4 inside an int for Win32ResizeDIBSection
+#define CAPTURE_MAX_DIMENSION 16384
+#define CAPTURE_QUEUE_SIZE 4
+#define CAPTURE_MAX_PACKET_WORDS 128
+
+typedef struct
+{
+    uint32 Magic;
+    uint32 Width;
+    uint32 Height;
+    uint32 TileSize;
+} capture_file_header;
+
+typedef struct
+{
+    uint32 FrameIndex;
+    uint32 ChangedTileCount;
+    // Bytes of tile data following this header
+    uint32 PayloadSize;
+} capture_frame_header;
+
+typedef enum
+{
+    CaptureTile_XorRuns = 0,
+    CaptureTile_LeftRuns = 1,
+    CaptureTile_Raw = 2,
+} capture_tile_encoding;
+
+typedef struct
+{
+    uint32 TileIndex;
+    // capture_tile_encoding
+    uint32 Encoding;
+    uint32 EncodedSize;
+} capture_tile_header;
+
+typedef struct
+{
+    int Width;
+    int Height;
+    int TileSize;
+    int TilesX;
+    int TilesY;
+    // Tile-sized scratch holding the words of one tile before/after run coding
+    uint32 *TileScratch;
+    // Encoder only: CaptureMaxTileEncodedSize bytes for the second run attempt
+    uint8 *EncodeScratch;
+} capture_codec;
+
+internal_function uint32
+CaptureMaxTileEncodedSize(int TileSize)
+{
+    // Worst case is all literals: one header byte per CAPTURE_MAX_PACKET_WORDS words
+    uint32 TilePixels = TileSize * TileSize;
+    return (TilePixels * sizeof(uint32) +
+            (TilePixels + CAPTURE_MAX_PACKET_WORDS - 1) / CAPTURE_MAX_PACKET_WORDS);
+}
+
+internal_function uint32
+CaptureMaxFrameSize(capture_codec *Codec)
+{
+    uint32 TileCount = Codec->TilesX * Codec->TilesY;
+    return (sizeof(capture_frame_header) +
+            TileCount * (sizeof(capture_tile_header) + CaptureMaxTileEncodedSize(Codec->TileSize)));
+}
+
+internal_function uint32
+CaptureEncodeRuns(uint32 *Words, uint32 WordCount, uint8 *Out)
+{
+    uint8 *Start = Out;
+    uint32 Index = 0;
+    while (Index < WordCount)
+    {
+        uint32 Run = 1;
+        while (Index + Run < WordCount &&
+               Run < CAPTURE_MAX_PACKET_WORDS &&
+               Words[Index + Run] == Words[Index])
+        {
+            ++Run;
+        }
+
+        if (Run >= 2)
+        {
+            *Out++ = (uint8)(0x80 | (Run - 1));
+            memcpy(Out, &Words[Index], sizeof(uint32));
+            Out += sizeof(uint32);
+            Index += Run;
+        }
+        else
+        {
+            // Take literals up to the start of the next run
+            uint32 Literal = 1;
+            while (Index + Literal < WordCount &&
+                   Literal < CAPTURE_MAX_PACKET_WORDS &&
+                   !(Index + Literal + 1 < WordCount &&
+                     Words[Index + Literal] == Words[Index + Literal + 1]))
+            {
+                ++Literal;
+            }
+
+            *Out++ = (uint8)(Literal - 1);
+            memcpy(Out, &Words[Index], Literal * sizeof(uint32));
+            Out += Literal * sizeof(uint32);
+            Index += Literal;
+        }
+    }
+
+    return (uint32)(Out - Start);
+}
+
+internal_function bool
+CaptureDecodeRuns(uint8 *In, uint32 InSize, uint32 *Words, uint32 WordCount)
+{
+    uint8 *End = In + InSize;
+    uint32 Index = 0;
+    while (In < End)
+    {
+        uint8 Header = *In++;
+        uint32 Count = (Header & 0x7F) + 1;
+        if (Index + Count > WordCount)
+        {
+            return false;
+        }
+
+        if (Header & 0x80)
+        {
+            if (End - In < (int64)sizeof(uint32))
+            {
+                return false;
+            }
+            uint32 Value;
+            memcpy(&Value, In, sizeof(uint32));
+            In += sizeof(uint32);
+            for (uint32 Word = 0; Word < Count; ++Word)
+            {
+                Words[Index++] = Value;
+            }
+        }
+        else
+        {
+            if (End - In < (int64)(Count * sizeof(uint32)))
+            {
+                return false;
+            }
+            memcpy(&Words[Index], In, Count * sizeof(uint32));
+            In += Count * sizeof(uint32);
+            Index += Count;
+        }
+    }
+
+    return (Index == WordCount);
+}
+
+internal_function uint32
+CaptureEncodeFrame(capture_codec *Codec, uint32 FrameIndex,
+                   uint8 *Pixels, int Pitch,
+                   uint8 *PrevPixels, int PrevPitch,
+                   uint8 *Out)
+{
+    /*
+        Writes the frame header and every tile that differs from PrevPixels
+        to Out, then copies those tiles into PrevPixels so it tracks the
+        decoder's view of the stream. Returns bytes written.
+    */
+    capture_frame_header Header = {};
+    Header.FrameIndex = FrameIndex;
+    uint8 *Cursor = Out + sizeof(Header);
+
+    for (int TileY = 0;
+         TileY < Codec->TilesY;
+         ++TileY)
+    {
+        int MinY = TileY * Codec->TileSize;
+        int Rows = Codec->Height - MinY;
+        if (Rows > Codec->TileSize)
+        {
+            Rows = Codec->TileSize;
+        }
+
+        for (int TileX = 0;
+             TileX < Codec->TilesX;
+             ++TileX)
+        {
+            int MinX = TileX * Codec->TileSize;
+            int Columns = Codec->Width - MinX;
+            if (Columns > Codec->TileSize)
+            {
+                Columns = Codec->TileSize;
+            }
+            int RowBytes = Columns * sizeof(uint32);
+
+            uint8 *Row = Pixels + MinY * Pitch + MinX * sizeof(uint32);
+            uint8 *PrevRow = PrevPixels + MinY * PrevPitch + MinX * sizeof(uint32);
+
+            // Most tiles are untouched between frames, so reject them with memcmp first
+            bool Changed = false;
+            for (int Y = 0; Y < Rows; ++Y)
+            {
+                if (memcmp(Row + Y * Pitch, PrevRow + Y * PrevPitch, RowBytes) != 0)
+                {
+                    Changed = true;
+                    break;
+                }
+            }
+            if (!Changed)
+            {
+                continue;
+            }
+
+            uint32 *Delta = Codec->TileScratch;
+            for (int Y = 0; Y < Rows; ++Y)
+            {
+                uint32 *Pixel = (uint32 *)(Row + Y * Pitch);
+                uint32 *PrevPixel = (uint32 *)(PrevRow + Y * PrevPitch);
+                for (int X = 0; X < Columns; ++X)
+                {
+                    *Delta++ = Pixel[X] ^ PrevPixel[X];
+                    PrevPixel[X] = Pixel[X];
+                }
+            }
+
+            uint32 TilePixels = Rows * Columns;
+            uint32 RawSize = TilePixels * sizeof(uint32);
+            uint8 *TileData = Cursor + sizeof(capture_tile_header);
+
+            capture_tile_header TileHeader;
+            TileHeader.TileIndex = TileY * Codec->TilesX + TileX;
+            TileHeader.Encoding = CaptureTile_XorRuns;
+            TileHeader.EncodedSize = CaptureEncodeRuns(Codec->TileScratch, TilePixels, TileData);
+
+            // Only pay for the second pass when the XOR runs compressed poorly
+            if (TileHeader.EncodedSize > RawSize / 4)
+            {
+                uint32 *Difference = Codec->TileScratch;
+                for (int Y = 0; Y < Rows; ++Y)
+                {
+                    uint32 *Pixel = (uint32 *)(Row + Y * Pitch);
+                    *Difference++ = Pixel[0];
+                    for (int X = 1; X < Columns; ++X)
+                    {
+                        *Difference++ = Pixel[X] - Pixel[X - 1];
+                    }
+                }
+
+                uint32 LeftSize = CaptureEncodeRuns(Codec->TileScratch, TilePixels, Codec->EncodeScratch);
+                if (LeftSize < TileHeader.EncodedSize)
+                {
+                    TileHeader.Encoding = CaptureTile_LeftRuns;
+                    TileHeader.EncodedSize = LeftSize;
+                    memcpy(TileData, Codec->EncodeScratch, LeftSize);
+                }
+            }
+
+            if (TileHeader.EncodedSize >= RawSize)
+            {
+                TileHeader.Encoding = CaptureTile_Raw;
+                TileHeader.EncodedSize = RawSize;
+                for (int Y = 0; Y < Rows; ++Y)
+                {
+                    memcpy(TileData + Y * RowBytes, Row + Y * Pitch, RowBytes);
+                }
+            }
+
+            memcpy(Cursor, &TileHeader, sizeof(TileHeader));
+            Cursor += sizeof(TileHeader) + TileHeader.EncodedSize;
+            ++Header.ChangedTileCount;
+        }
+    }
+
+    Header.PayloadSize = (uint32)(Cursor - Out - sizeof(Header));
+    memcpy(Out, &Header, sizeof(Header));
+
+    return (uint32)(Cursor - Out);
+}
+
+internal_function bool
+CaptureDecodeFrame(capture_codec *Codec, uint8 *In, uint32 InSize,
+                   uint8 *Pixels, int Pitch, uint32 *BytesRead)
+{
+    /*
+        Applies one encoded frame on top of the previous frame held in Pixels.
+        Returns false on a truncated or corrupt frame.
+    */
+    capture_frame_header Header;
+    if (InSize < sizeof(Header))
+    {
+        return false;
+    }
+    memcpy(&Header, In, sizeof(Header));
+    if (Header.PayloadSize > InSize - sizeof(Header))
+    {
+        return false;
+    }
+
+    uint8 *Cursor = In + sizeof(Header);
+    uint8 *End = Cursor + Header.PayloadSize;
+    uint32 TileCount = Codec->TilesX * Codec->TilesY;
+
+    for (uint32 TileNumber = 0;
+         TileNumber < Header.ChangedTileCount;
+         ++TileNumber)
+    {
+        capture_tile_header TileHeader;
+        if (End - Cursor < (int64)sizeof(TileHeader))
+        {
+            return false;
+        }
+        memcpy(&TileHeader, Cursor, sizeof(TileHeader));
+        Cursor += sizeof(TileHeader);
+        if (TileHeader.TileIndex >= TileCount ||
+            TileHeader.EncodedSize > (uint32)(End - Cursor))
+        {
+            return false;
+        }
+
+        int MinX = (TileHeader.TileIndex % Codec->TilesX) * Codec->TileSize;
+        int MinY = (TileHeader.TileIndex / Codec->TilesX) * Codec->TileSize;
+        int Columns = Codec->Width - MinX;
+        if (Columns > Codec->TileSize)
+        {
+            Columns = Codec->TileSize;
+        }
+        int Rows = Codec->Height - MinY;
+        if (Rows > Codec->TileSize)
+        {
+            Rows = Codec->TileSize;
+        }
+
+        uint32 TilePixels = Rows * Columns;
+        int RowBytes = Columns * sizeof(uint32);
+        uint8 *Row = Pixels + MinY * Pitch + MinX * sizeof(uint32);
+        if (TileHeader.Encoding == CaptureTile_Raw)
+        {
+            if (TileHeader.EncodedSize != TilePixels * sizeof(uint32))
+            {
+                return false;
+            }
+            for (int Y = 0; Y < Rows; ++Y)
+            {
+                memcpy(Row + Y * Pitch, Cursor + Y * RowBytes, RowBytes);
+            }
+        }
+        else if (TileHeader.Encoding == CaptureTile_XorRuns ||
+                 TileHeader.Encoding == CaptureTile_LeftRuns)
+        {
+            if (!CaptureDecodeRuns(Cursor, TileHeader.EncodedSize, Codec->TileScratch, TilePixels))
+            {
+                return false;
+            }
+
+            uint32 *Word = Codec->TileScratch;
+            for (int Y = 0; Y < Rows; ++Y)
+            {
+                uint32 *Pixel = (uint32 *)(Row + Y * Pitch);
+                if (TileHeader.Encoding == CaptureTile_XorRuns)
+                {
+                    for (int X = 0; X < Columns; ++X)
+                    {
+                        Pixel[X] ^= *Word++;
+                    }
+                }
+                else
+                {
+                    Pixel[0] = *Word++;
+                    for (int X = 1; X < Columns; ++X)
+                    {
+                        Pixel[X] = Pixel[X - 1] + *Word++;
+                    }
+                }
+            }
+        }
+        else
+        {
+            return false;
+        }
+        Cursor += TileHeader.EncodedSize;
+    }
+
+    if (Cursor != End)
+    {
+        return false;
+    }
+
+    *BytesRead = sizeof(Header) + Header.PayloadSize;
+    return true;
+}
+
+typedef struct
+{
+    uint8 *Memory;
+    uint32 Size;
+} capture_packet;
+
+typedef struct
+{
+    capture_codec Codec;
+    HANDLE File;
+    HANDLE WriterThread;
+    // Counts queued packets, plus one extra release when stopping
+    HANDLE PacketSemaphore;
+    volatile LONG QueuedCount;
+    volatile LONG StopRequested;
+    // Set by the writer on a failed write, every later delta would be undecodable
+    volatile LONG WriteFailed;
+    // WriteIndex is owned by the render thread, ReadIndex by the writer thread
+    int WriteIndex;
+    int ReadIndex;
+    capture_packet Packets[CAPTURE_QUEUE_SIZE];
+    uint32 PacketCapacity;
+    // Last frame handed to the writer, what the decoder will have reconstructed
+    uint8 *PrevFrame;
+    uint32 FrameIndex;
+
+    // Benchmark counters, Written* are only touched by the writer thread
+    uint32 CapturedFrames;
+    uint32 DroppedFrames;
+    int64 CaptureTicks;
+    uint32 WrittenFrames;
+    uint64 WrittenBytes;
+} win32_capture;
+
+DWORD WINAPI
+Win32CaptureWriterThread(LPVOID Parameter)
+{
+    /*
+        Drains encoded packets to disk so the render loop never waits on WriteFile
+    */
+    win32_capture *Capture = (win32_capture *)Parameter;
+    for (;;)
+    {
+        WaitForSingleObject(Capture->PacketSemaphore, INFINITE);
+        if (Capture->QueuedCount == 0)
+        {
+            // Every packet release comes before the stop release, so the queue is drained
+            if (Capture->StopRequested)
+            {
+                break;
+            }
+            continue;
+        }
+
+        // After a failed write the queue is only drained, never written
+        capture_packet *Packet = &Capture->Packets[Capture->ReadIndex];
+        if (!Capture->WriteFailed)
+        {
+            DWORD BytesWritten;
+            if (WriteFile(Capture->File, Packet->Memory, Packet->Size, &BytesWritten, 0) &&
+                BytesWritten == Packet->Size)
+            {
+                ++Capture->WrittenFrames;
+                Capture->WrittenBytes += Packet->Size;
+            }
+            else
+            {
+                OutputDebugStringA("Failed to write capture packet, capture stopped\n");
+                InterlockedExchange(&Capture->WriteFailed, 1);
+            }
+        }
+        Capture->ReadIndex = (Capture->ReadIndex + 1) % CAPTURE_QUEUE_SIZE;
+        InterlockedDecrement(&Capture->QueuedCount);
+    }
+
+    return 0;
+}
+
+internal_function bool
+Win32BeginCapture(win32_capture *Capture, char *FileName, win32_backbuffer *Buffer)
+{
+    capture_codec *Codec = &Capture->Codec;
+    Codec->Width = Buffer->BitmapWidth;
+    Codec->Height = Buffer->BitmapHeight;
+    Codec->TileSize = CAPTURE_TILE_SIZE;
+    Codec->TilesX = (Codec->Width + Codec->TileSize - 1) / Codec->TileSize;
+    Codec->TilesY = (Codec->Height + Codec->TileSize - 1) / Codec->TileSize;
+
+    Capture->File = CreateFileA(FileName, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    if (Capture->File == INVALID_HANDLE_VALUE)
+    {
+        OutputDebugStringA("Failed to create capture file\n");
+        return false;
+    }
+
+    capture_file_header FileHeader;
+    FileHeader.Magic = CAPTURE_MAGIC;
+    FileHeader.Width = Codec->Width;
+    FileHeader.Height = Codec->Height;
+    FileHeader.TileSize = Codec->TileSize;
+    DWORD BytesWritten;
+    if (!WriteFile(Capture->File, &FileHeader, sizeof(FileHeader), &BytesWritten, 0) ||
+        BytesWritten != sizeof(FileHeader))
+    {
+        OutputDebugStringA("Failed to write capture file header\n");
+        CloseHandle(Capture->File);
+        return false;
+    }
+
+    // One block for the reference frame, tile scratches and every packet slot
+    // NOTE: VirtualAlloc zeroes the block, which gives the all-zero starting frame
+    uint32 FrameSize = Codec->Width * Codec->Height * sizeof(uint32);
+    uint32 TileScratchSize = Codec->TileSize * Codec->TileSize * sizeof(uint32);
+    uint32 ScratchSize = TileScratchSize + CaptureMaxTileEncodedSize(Codec->TileSize);
+    Capture->PacketCapacity = CaptureMaxFrameSize(Codec);
+    uint8 *Memory = (uint8 *)VirtualAlloc(0, FrameSize + ScratchSize + CAPTURE_QUEUE_SIZE * Capture->PacketCapacity,
+                                          MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!Memory)
+    {
+        OutputDebugStringA("Failed to allocate capture memory\n");
+        CloseHandle(Capture->File);
+        return false;
+    }
+    Capture->PrevFrame = Memory;
+    Codec->TileScratch = (uint32 *)(Memory + FrameSize);
+    Codec->EncodeScratch = Memory + FrameSize + TileScratchSize;
+    for (int PacketIndex = 0;
+         PacketIndex < CAPTURE_QUEUE_SIZE;
+         ++PacketIndex)
+    {
+        Capture->Packets[PacketIndex].Memory = Memory + FrameSize + ScratchSize + PacketIndex * Capture->PacketCapacity;
+    }
+
+    // The writer waits on the semaphore, so it must exist before the thread starts
+    Capture->PacketSemaphore = CreateSemaphoreA(0, 0, CAPTURE_QUEUE_SIZE + 1, 0);
+    if (!Capture->PacketSemaphore)
+    {
+        OutputDebugStringA("Failed to create capture semaphore\n");
+        VirtualFree(Memory, 0, MEM_RELEASE);
+        CloseHandle(Capture->File);
+        return false;
+    }
+
+    Capture->WriterThread = CreateThread(0, 0, Win32CaptureWriterThread, Capture, 0, 0);
+    if (!Capture->WriterThread)
+    {
+        OutputDebugStringA("Failed to start capture writer thread\n");
+        CloseHandle(Capture->PacketSemaphore);
+        VirtualFree(Memory, 0, MEM_RELEASE);
+        CloseHandle(Capture->File);
+        return false;
+    }
+
+    return true;
+}
+
+internal_function void
+Win32CaptureFrame(win32_capture *Capture, win32_backbuffer *Buffer)
+{
+    /*
+        Encodes the Backbuffer into the next free packet slot and hands it to the writer.
+        When the writer falls behind the frame is dropped; PrevFrame is left untouched,
+        so the next captured frame is still a valid delta for the decoder.
+    */
+    capture_codec *Codec = &Capture->Codec;
+    if (Buffer->BitmapWidth != Codec->Width || Buffer->BitmapHeight != Codec->Height)
+    {
+        OutputDebugStringA("Backbuffer size changed, frame not captured\n");
+        return;
+    }
+    if (Capture->WriteFailed)
+    {
+        return;
+    }
+
+    uint32 FrameIndex = Capture->FrameIndex++;
+    if (Capture->QueuedCount == CAPTURE_QUEUE_SIZE)
+    {
+        ++Capture->DroppedFrames;
+    }
+    else
+    {
+        // Only time encoded frames, a cheap drop would hide the real per-frame cost
+        LARGE_INTEGER Start;
+        QueryPerformanceCounter(&Start);
+
+        capture_packet *Packet = &Capture->Packets[Capture->WriteIndex];
+        Packet->Size = CaptureEncodeFrame(Codec, FrameIndex,
+                                          (uint8 *)Buffer->BitmapMemory, Buffer->Pitch,
+                                          Capture->PrevFrame, Codec->Width * sizeof(uint32),
+                                          Packet->Memory);
+        Capture->WriteIndex = (Capture->WriteIndex + 1) % CAPTURE_QUEUE_SIZE;
+        InterlockedIncrement(&Capture->QueuedCount);
+        ReleaseSemaphore(Capture->PacketSemaphore, 1, 0);
+
+        LARGE_INTEGER End;
+        QueryPerformanceCounter(&End);
+        Capture->CaptureTicks += End.QuadPart - Start.QuadPart;
+        ++Capture->CapturedFrames;
+    }
+}
+
+internal_function void
+Win32EndCapture(win32_capture *Capture, char *Report, int ReportSize)
+{
+    /*
+        Flushes the queue, closes the file and writes the capture benchmark to Report
+    */
+    InterlockedExchange(&Capture->StopRequested, 1);
+    ReleaseSemaphore(Capture->PacketSemaphore, 1, 0);
+    WaitForSingleObject(Capture->WriterThread, INFINITE);
+    CloseHandle(Capture->WriterThread);
+    CloseHandle(Capture->PacketSemaphore);
+    CloseHandle(Capture->File);
+    VirtualFree(Capture->PrevFrame, 0, MEM_RELEASE);
+
+    LARGE_INTEGER Frequency;
+    QueryPerformanceFrequency(&Frequency);
+    real64 MicrosecondsPerFrame = 0.0;
+    real64 CompressionRatio = 0.0;
+    if (Capture->CapturedFrames)
+    {
+        MicrosecondsPerFrame = (1000000.0 * (real64)Capture->CaptureTicks) /
+                               ((real64)Frequency.QuadPart * (real64)Capture->CapturedFrames);
+    }
+    // Ratio only covers what actually reached the file
+    uint64 RawBytes = (uint64)Capture->WrittenFrames * Capture->Codec.Width * Capture->Codec.Height * sizeof(uint32);
+    if (Capture->WrittenBytes)
+    {
+        CompressionRatio = (real64)RawBytes / (real64)Capture->WrittenBytes;
+    }
+
+    snprintf(Report, ReportSize,
+             "Capture: %u frames written (%u dropped)%s, %.1f us/frame encode, %llu -> %llu bytes, %.1f:1 compression\n",
+             Capture->WrittenFrames, Capture->DroppedFrames,
+             Capture->WriteFailed ? ", WRITE FAILED, file truncated" : "",
+             MicrosecondsPerFrame,
+             (unsigned long long)RawBytes, (unsigned long long)Capture->WrittenBytes,
+             CompressionRatio);
+    OutputDebugStringA(Report);
+}
+
+typedef struct
+{
+    capture_codec Codec;
+    // Tile scratch first so it stays 4-byte aligned, the file contents follow it
+    uint8 *Memory;
+    uint8 *Stream;
+    uint32 Size;
+    uint32 ReadOffset;
+} win32_replay;
+
+internal_function bool
+Win32BeginReplay(win32_replay *Replay, char *FileName)
+{
+    /*
+        Loads a whole capture file into memory for frame by frame decoding
+    */
+    HANDLE File = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        OutputDebugStringA("Failed to open capture file\n");
+        return false;
+    }
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize) ||
+        FileSize.QuadPart < (int64)sizeof(capture_file_header) ||
+        FileSize.QuadPart > 0xFFFFFFFF)
+    {
+        OutputDebugStringA("Invalid capture file size\n");
+        CloseHandle(File);
+        return false;
+    }
+
+    Replay->Size = (uint32)FileSize.QuadPart;
+    uint32 ScratchSize = CAPTURE_MAX_TILE_SIZE * CAPTURE_MAX_TILE_SIZE * sizeof(uint32);
+    Replay->Memory = (uint8 *)VirtualAlloc(0, (SIZE_T)Replay->Size + ScratchSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    DWORD BytesRead = 0;
+    bool Loaded = (Replay->Memory &&
+                   ReadFile(File, Replay->Memory + ScratchSize, Replay->Size, &BytesRead, 0) &&
+                   BytesRead == Replay->Size);
+    CloseHandle(File);
+
+    capture_file_header FileHeader = {};
+    if (Loaded)
+    {
+        Replay->Stream = Replay->Memory + ScratchSize;
+        memcpy(&FileHeader, Replay->Stream, sizeof(FileHeader));
+    }
+    if (FileHeader.Magic != CAPTURE_MAGIC ||
+        FileHeader.TileSize == 0 || FileHeader.TileSize > CAPTURE_MAX_TILE_SIZE ||
+        FileHeader.Width == 0 || FileHeader.Width > CAPTURE_MAX_DIMENSION ||
+        FileHeader.Height == 0 || FileHeader.Height > CAPTURE_MAX_DIMENSION)
+    {
+        OutputDebugStringA("Invalid capture file\n");
+        if (Replay->Memory)
+        {
+            VirtualFree(Replay->Memory, 0, MEM_RELEASE);
+        }
+        return false;
+    }
+
+    capture_codec *Codec = &Replay->Codec;
+    Codec->Width = FileHeader.Width;
+    Codec->Height = FileHeader.Height;
+    Codec->TileSize = FileHeader.TileSize;
+    Codec->TilesX = (Codec->Width + Codec->TileSize - 1) / Codec->TileSize;
+    Codec->TilesY = (Codec->Height + Codec->TileSize - 1) / Codec->TileSize;
+    Codec->TileScratch = (uint32 *)Replay->Memory;
+    Replay->ReadOffset = sizeof(FileHeader);
+
+    return true;
+}
+
+internal_function bool
+Win32ReplayFrame(win32_replay *Replay, win32_backbuffer *Buffer)
+{
+    /*
+        Decodes the next captured frame on top of the Backbuffer.
+        The Backbuffer must start zeroed and hold the previously replayed frame.
+        Returns false once the stream ends or is corrupt.
+    */
+    if (Replay->ReadOffset >= Replay->Size)
+    {
+        return false;
+    }
+
+    if (!Buffer->BitmapMemory ||
+        Buffer->BitmapWidth != Replay->Codec.Width ||
+        Buffer->BitmapHeight != Replay->Codec.Height)
+    {
+        OutputDebugStringA("Backbuffer does not match capture size, replay stopped\n");
+        Replay->ReadOffset = Replay->Size;
+        return false;
+    }
+
+    uint32 BytesRead;
+    if (!CaptureDecodeFrame(&Replay->Codec,
+                            Replay->Stream + Replay->ReadOffset, Replay->Size - Replay->ReadOffset,
+                            (uint8 *)Buffer->BitmapMemory, Buffer->Pitch, &BytesRead))
+    {
+        OutputDebugStringA("Corrupt capture frame, replay stopped\n");
+        Replay->ReadOffset = Replay->Size;
+        return false;
+    }
+    Replay->ReadOffset += BytesRead;
+
+    return true;
+}
+
+internal_function void
+Win32EndReplay(win32_replay *Replay)
+{
+    VirtualFree(Replay->Memory, 0, MEM_RELEASE);
+    Replay->Memory = 0;
+    Replay->Stream = 0;
+}
+
+typedef struct
+{
+    char *Name;
+    int XStep;
+    int YStep;
+} capture_benchmark_scene;
+
+#define CAPTURE_BENCHMARK_FRAMES 300
+
+internal_function void
+RenderBenchmarkFrame(capture_benchmark_scene *Scene, int Frame)
+{
+    // Scripted scroll, so every run renders the same frames
+    GlobalXOffset = Frame * Scene->XStep;
+    GlobalYOffset = Frame * Scene->YStep;
+    RenderGradient(GlobalBackbuffer);
+}
+
+internal_function bool
+Win32RunCaptureBenchmark(char *FileName)
+{
+    /*
+        Captures CAPTURE_BENCHMARK_FRAMES of each scripted scene to FileName,
+        prints the capture report, then replays the file and checks every
+        frame bit-exactly against the re-rendered scene.
+        Returns false if any scene fails to capture or replay exactly.
+    */
+    capture_benchmark_scene Scenes[] =
+    {
+        {"static", 0, 0},
+        {"horizontal", 1, 0},
+        {"vertical", 0, 1},
+        {"diagonal", 1, 1},
+    };
+
+    bool AllExact = true;
+    win32_backbuffer Decoded = {};
+    Decoded.BytesPerPixel = GlobalBackbuffer.BytesPerPixel;
+
+    for (int SceneIndex = 0;
+         SceneIndex < (int)(sizeof(Scenes) / sizeof(Scenes[0]));
+         ++SceneIndex)
+    {
+        capture_benchmark_scene *Scene = &Scenes[SceneIndex];
+
+        win32_capture Capture = {};
+        if (!Win32BeginCapture(&Capture, FileName, &GlobalBackbuffer))
+        {
+            printf("%-10s capture failed to start\n", Scene->Name);
+            return false;
+        }
+        for (int Frame = 0;
+             Frame < CAPTURE_BENCHMARK_FRAMES;
+             ++Frame)
+        {
+            RenderBenchmarkFrame(Scene, Frame);
+            // Wait for the writer instead of dropping, so every run encodes the same frames
+            while (Capture.QueuedCount == CAPTURE_QUEUE_SIZE && !Capture.WriteFailed)
+            {
+                Sleep(0);
+            }
+            Win32CaptureFrame(&Capture, &GlobalBackbuffer);
+        }
+        char Report[256];
+        Win32EndCapture(&Capture, Report, sizeof(Report));
+
+        // Decode into a fresh zeroed buffer and compare with the re-rendered scene
+        win32_replay Replay = {};
+        bool Exact = Win32BeginReplay(&Replay, FileName);
+        if (Exact)
+        {
+            Win32ResizeDIBSection(&Decoded, Replay.Codec.Width, Replay.Codec.Height);
+            Exact = (Decoded.BitmapMemory != 0);
+            for (int Frame = 0;
+                 Exact && Frame < CAPTURE_BENCHMARK_FRAMES;
+                 ++Frame)
+            {
+                RenderBenchmarkFrame(Scene, Frame);
+                Exact = (Win32ReplayFrame(&Replay, &Decoded) &&
+                         memcmp(Decoded.BitmapMemory, GlobalBackbuffer.BitmapMemory,
+                                GlobalBackbuffer.Pitch * GlobalBackbuffer.BitmapHeight) == 0);
+            }
+            // Every captured byte must have been consumed
+            Exact = Exact && (Replay.ReadOffset == Replay.Size);
+            Win32EndReplay(&Replay);
+        }
+
+        printf("%-10s %s", Scene->Name, Report);
+        printf("%-10s replay %s\n", Scene->Name, Exact ? "bit-exact" : "MISMATCH");
+        AllExact = AllExact && Exact;
+    }
+
+    if (Decoded.BitmapMemory)
+    {
+        VirtualFree(Decoded.BitmapMemory, 0, MEM_RELEASE);
+    }
+    GlobalXOffset = 0;
+    GlobalYOffset = 0;
+    fflush(stdout);
+
+    return AllExact;
+}
+
 LRESULT CALLBACK
 MainWinCallback(HWND Window,
                 UINT Message,
@@ -435,6 +1312,34 @@ void Win32FillSoundBuffer(win32_sound_output *SoundOutput, DWORD ByteToLock, DWO
     }
 }
 
+internal_function char *
+Win32ParseFileArgument(char *Argument)
+{
+    /*
+        Trims whitespace and one pair of surrounding quotes from a path
+        argument in place, so -capture "C:\My Captures\a.rcap" opens the right file
+    */
+    while (*Argument == ' ' || *Argument == '\t')
+    {
+        ++Argument;
+    }
+
+    char *End = Argument + strlen(Argument);
+    while (End > Argument && (End[-1] == ' ' || End[-1] == '\t' || End[-1] == '\r' || End[-1] == '\n'))
+    {
+        --End;
+    }
+
+    if (End - Argument >= 2 && Argument[0] == '"' && End[-1] == '"')
+    {
+        ++Argument;
+        --End;
+    }
+    *End = 0;
+
+    return Argument;
+}
+
 int CALLBACK
 WinMain(HINSTANCE Instance,
         HINSTANCE PrevInstance,
@@ -445,6 +1350,12 @@ WinMain(HINSTANCE Instance,
     GlobalBackbuffer.BytesPerPixel = 4;
     Win32ResizeDIBSection(&GlobalBackbuffer, 1280, 720);
 
+    // "-benchmark <file>" runs the scripted capture benchmark without opening a window
+    if (strncmp(CommandLine, "-benchmark ", 11) == 0)
+    {
+        return (Win32RunCaptureBenchmark(Win32ParseFileArgument(CommandLine + 11)) ? 0 : 1);
+    }
+
     Win32LoadXInput();
 
     WNDCLASS WindowClass = {};
@@ -477,6 +1388,32 @@ WinMain(HINSTANCE Instance,
             // Process is running
             GlobalRunning = true;
 
+            // "-capture <file>" records every frame, "-replay <file>" plays a recording back
+            win32_capture Capture = {};
+            win32_replay Replay = {};
+            bool Capturing = false;
+            bool Replaying = false;
+            if (strncmp(CommandLine, "-capture ", 9) == 0)
+            {
+                Capturing = Win32BeginCapture(&Capture, Win32ParseFileArgument(CommandLine + 9), &GlobalBackbuffer);
+            }
+            else if (strncmp(CommandLine, "-replay ", 8) == 0)
+            {
+                Replaying = Win32BeginReplay(&Replay, Win32ParseFileArgument(CommandLine + 8));
+                if (Replaying)
+                {
+                    // Fresh (zeroed) Backbuffer at the captured size, the first frame decodes against it
+                    Win32ResizeDIBSection(&GlobalBackbuffer, Replay.Codec.Width, Replay.Codec.Height);
+                    if (!GlobalBackbuffer.BitmapMemory)
+                    {
+                        OutputDebugStringA("Failed to allocate replay Backbuffer\n");
+                        VirtualFree(Replay.Memory, 0, MEM_RELEASE);
+                        Replaying = false;
+                        Win32ResizeDIBSection(&GlobalBackbuffer, 1280, 720);
+                    }
+                }
+            }
+
             HDC DeviceContext = GetDC(Window);
 
             win32_sound_output SineWave;
@@ -631,11 +1568,30 @@ WinMain(HINSTANCE Instance,
                     Win32FillSoundBuffer(&SineWave, ByteToLock, BytesToWrite);
                 }
 
-                RenderGradient(GlobalBackbuffer);
+                if (Replaying)
+                {
+                    // Hold the last frame once the recording runs out
+                    Win32ReplayFrame(&Replay, &GlobalBackbuffer);
+                }
+                else
+                {
+                    RenderGradient(GlobalBackbuffer);
+                }
+
+                if (Capturing)
+                {
+                    Win32CaptureFrame(&Capture, &GlobalBackbuffer);
+                }
 
                 win32_window_dimension Dim = Win32GetWindowDimension(Window);
                 Win32UpdateWindow(&GlobalBackbuffer, DeviceContext, Dim.Width, Dim.Height);
             }
+
+            if (Capturing)
+            {
+                char Report[256];
+                Win32EndCapture(&Capture, Report, sizeof(Report));
+            }
         }
         else
         {